@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+
+//Minimal std::allocator replacement that hands out memory aligned to 'Alignment' bytes.
+//Used for limb storage so SIMD kernels never straddle a cache line at the start of a number.
+template<typename T, size_t Alignment>
+class AlignedAllocator
+{
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+	AlignedAllocator() noexcept {}
+	template<typename U>
+	AlignedAllocator( const AlignedAllocator<U, Alignment>& ) noexcept {}
+
+	T* allocate( size_t count )
+	{
+		if( count == 0 )
+			return nullptr;
+		if( count > size_t( -1 ) / sizeof( T ) )
+			throw std::bad_alloc();
+
+		//round up to a whole number of alignment blocks, some aligned allocators insist on it
+		size_t bytes = ( ( count * sizeof( T ) + Alignment - 1 ) / Alignment ) * Alignment;
+		void* p = nullptr;
+#ifdef _WIN32
+		p = _aligned_malloc( bytes, Alignment );
+#else
+		if( posix_memalign( &p, Alignment, bytes ) != 0 )
+			p = nullptr;
+#endif
+		if( p == nullptr )
+			throw std::bad_alloc();
+		return static_cast<T*>( p );
+	}
+
+	void deallocate( T* p, size_t ) noexcept
+	{
+#ifdef _WIN32
+		_aligned_free( p );
+#else
+		free( p );
+#endif
+	}
+};
+
+template<typename T, typename U, size_t Alignment>
+inline bool operator==( const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>& ) { return true; }
+template<typename T, typename U, size_t Alignment>
+inline bool operator!=( const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>& ) { return false; }
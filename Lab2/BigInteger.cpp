@@ -1,4 +1,5 @@
 #include "BigInteger.h"
+#include "LimbKernels.h"
 #include <sstream>
 using std::stringstream;
 #include <algorithm>
@@ -239,22 +240,27 @@ BigInteger BigInteger::operator--( int kind )
 	return copy;
 }
 
+//Schoolbook multiplication, one kernel sweep per limb of the shorter number
 BigInteger BigInteger::operator*( const BigInteger & rhs ) const
 {
-	BigInteger sum = 0;
-	size_t num_digits = this->_bits.size();
-	for( size_t idx = 0; idx < num_digits; ++idx )
-	{
-		for( int i = 0; i < bits_per_value; ++i )
-		{
-			uint32_t bit_idx = ( i * num_digits ) + idx;
-			bool bit = this->get_bit( bit_idx );
-			if( bit )
-				sum += rhs << bit_idx;
-		}
-	}
-	sum._negative = ( this->_negative != rhs._negative ); //different signs is negative, same sign is positive
-	return sum;
+	const limb_kernels::kernel_table& kernels = limb_kernels::active();
+	const limb_vector* longer = bigger_array( this->_bits, rhs._bits );
+	const limb_vector* shorter = ( longer == &this->_bits ) ? &rhs._bits : &this->_bits;
+	size_t n = longer->size(), m = shorter->size();
+
+	BigInteger product;
+	product._bits.resize( n + m );
+	uint32_t* r = product._bits.data();
+
+	//the first row initializes the product, every other row accumulates into it one limb further up
+	r[n] = kernels.mul_1( r, longer->data(), n, ( *shorter )[0] );
+	for( size_t j = 1; j < m; ++j )
+		r[n + j] = kernels.addmul_1( r + j, longer->data(), n, ( *shorter )[j] );
+
+	product.trim();
+	if( product != ZERO )
+		product._negative = ( this->_negative != rhs._negative ); //different signs is negative, same sign is positive
+	return product;
 }
 
 BigInteger& BigInteger::operator*=( const BigInteger & rhs )
@@ -311,14 +317,12 @@ bool BigInteger::operator<( const BigInteger & rhs ) const
 	if( this_size > rhs_size )
 		return !( !this->_negative && !rhs._negative ); //if they're both positive then false else true;
 
-	//the sizes are equal, so we can iterate over both with a single index
-	for( int32_t i = this_size - 1; i >= 0; --i )
-	{
-		if( this->_bits[i] < rhs._bits[i] )
-			return ( !this->_negative && !rhs._negative );
-		if( this->_bits[i] > rhs._bits[i] )
-			return !( !this->_negative && !rhs._negative );
-	}
+	//the sizes are equal, so we can compare both magnitudes in a single sweep
+	int cmp = limb_kernels::active().cmp( this->_bits.data(), rhs._bits.data(), this_size );
+	if( cmp < 0 )
+		return ( !this->_negative && !rhs._negative );
+	if( cmp > 0 )
+		return !( !this->_negative && !rhs._negative );
 
 	//all ths bits are equal if we got here
 	return false;
@@ -340,14 +344,12 @@ bool BigInteger::operator<=( const BigInteger & rhs ) const
 	if( this_size > rhs_size )
 		return !( !this->_negative && !rhs._negative ); //if they're both positive then false else true
 
-	//the sizes are equal, so we can iterate over both with a single index
-	for( size_t i = this_size - 1; i >= 0; --i )
-	{
-		if( this->_bits[i] < rhs._bits[i] )
-			return ( !this->_negative && !rhs._negative );
-		if( this->_bits[i] > rhs._bits[i] )
-			return !( !this->_negative && !rhs._negative );
-	}
+	//the sizes are equal, so we can compare both magnitudes in a single sweep
+	int cmp = limb_kernels::active().cmp( this->_bits.data(), rhs._bits.data(), this_size );
+	if( cmp < 0 )
+		return ( !this->_negative && !rhs._negative );
+	if( cmp > 0 )
+		return !( !this->_negative && !rhs._negative );
 
 	//all ths bits are equal if we got here
 	return true;
@@ -366,94 +368,96 @@ bool BigInteger::operator!=( const BigInteger& rhs ) const
 	return !( this->operator==( rhs ) );
 }
 
-//unsigned 32 bit overflow is guaranteed behavior in C/C++ so I'm fine to rely on it.
 BigInteger BigInteger::operator<<( uint32_t lshift ) const
 {
 	BigInteger copy = *this;
-	if( lshift >= bits_per_value )
-	{ //an optimization. If we're shifting over 70 bits, we can just add 64 new bits of LSB-side zeros and then do the actual last 6 bits manually
-		copy._bits.insert( copy._bits.begin(), lshift / 32, 0 );
-		lshift %= bits_per_value;
-	}
-
-	while( lshift-- > 0 )
-	{
-		int carry_bit = 0;
-		for( uint32_t& val : copy._bits )
-		{
-			int temp_carry = ( val >> 31 ) & 1;
-			val <<= 1;
-			val |= carry_bit; //1 or 0
-			carry_bit = temp_carry;
-		}
-		if( carry_bit )
-			copy._bits.push_back( 1 );
-	}
-	return copy;
+	return copy <<= lshift;
 }
 
+//Shifting by whole limbs is just inserting zeros at the bottom, the leftover bits take a single kernel sweep
 BigInteger & BigInteger::operator<<=( uint32_t lshift )
 {
-	if( lshift >= bits_per_value )
+	uint32_t bits = lshift % bits_per_value;
+	if( bits )
 	{
-		this->_bits.insert( this->_bits.begin(), lshift / 32, 0 );
-		lshift %= bits_per_value;
+		uint32_t carry = limb_kernels::active().lshift( _bits.data(), _bits.data(), _bits.size(), bits );
+		if( carry )
+			_bits.push_back( carry );
 	}
 
-	while( lshift-- > 0 )
-	{
-		int carry_bit = 0;
-		for( uint32_t& val : _bits )
-		{
-			int temp_carry = ( val >> 31 ) & 1;
-			val <<= 1;
-			//the least significant bit will be 0 after the above operation
-			val |= carry_bit; //1 or 0
-			//now the least significant bit will be equal to carry_bit
-			carry_bit = temp_carry;
-			//keep track of what the most significant bit was before the shift, since it got shifted to oblivion
-		}
-		if( carry_bit )
-			_bits.push_back( 1 );
-	}
+	trim();
+	if( lshift >= bits_per_value && _bits.back() != 0 ) //zero stays a single limb
+		_bits.insert( _bits.begin(), lshift / bits_per_value, 0 );
 	return *this;
 }
 
 BigInteger BigInteger::operator >> ( uint32_t rshift ) const
 {
 	BigInteger copy = *this;
-	while( rshift-- > 0 )
-	{
-		int carry_bit = 0;
-		for( int32_t i = (int32_t)copy._bits.size() - 1; i >= 0; --i )
-		{
-			int temp_carry = copy._bits[i] & 1;
-			copy._bits[i] >>= 1;
-			copy._bits[i] |= ( carry_bit << ( bits_per_value - 1 ) );
-			carry_bit = temp_carry;
-		}
-	}
-	copy.trim();
-	return copy;
+	return copy >>= rshift;
 }
 
 BigInteger & BigInteger::operator>>=( uint32_t rshift )
 {
-	while( rshift-- > 0 )
+	size_t limbs = rshift / bits_per_value;
+	if( limbs >= _bits.size() ) //everything got shifted out
 	{
-		int carry_bit = 0;
-		for( int32_t i = (int32_t)_bits.size() - 1; i >= 0; --i )
-		{
-			int temp_carry = _bits[i] & 1;
-			_bits[i] >>= 1;
-			_bits[i] |= ( carry_bit << ( bits_per_value - 1 ) );
-			carry_bit = temp_carry;
-		}
+		_bits.assign( 1, 0 );
+		_negative = false;
+		return *this;
 	}
+
+	_bits.erase( _bits.begin(), _bits.begin() + limbs );
+	uint32_t bits = rshift % bits_per_value;
+	if( bits )
+		limb_kernels::active().rshift( _bits.data(), _bits.data(), _bits.size(), bits );
+
 	trim();
+	if( _bits.size() == 1 && _bits[0] == 0 )
+		_negative = false;
 	return *this;
 }
 
+BigInteger BigInteger::operator&( const BigInteger & rhs ) const
+{
+	return bitwise( *this, rhs, bitwise_and );
+}
+
+BigInteger & BigInteger::operator&=( const BigInteger & rhs )
+{
+	return *this = bitwise( *this, rhs, bitwise_and );
+}
+
+BigInteger BigInteger::operator|( const BigInteger & rhs ) const
+{
+	return bitwise( *this, rhs, bitwise_or );
+}
+
+BigInteger & BigInteger::operator|=( const BigInteger & rhs )
+{
+	return *this = bitwise( *this, rhs, bitwise_or );
+}
+
+BigInteger BigInteger::operator^( const BigInteger & rhs ) const
+{
+	return bitwise( *this, rhs, bitwise_xor );
+}
+
+BigInteger & BigInteger::operator^=( const BigInteger & rhs )
+{
+	return *this = bitwise( *this, rhs, bitwise_xor );
+}
+
+BigInteger BigInteger::operator~() const
+{
+	limb_vector limbs( _bits.size() + 1 );
+	to_twos_complement( limbs );
+
+	limb_kernels::active().com_n( limbs.data(), limbs.data(), limbs.size() );
+
+	return from_twos_complement( limbs );
+}
+
 uint32_t BigInteger::bits_allocated() const
 {
 	return _bits.size() * bits_per_value;
@@ -568,40 +572,17 @@ uint32_t BigInteger::get_lowest_set_bit()
 BigInteger BigInteger::internal_add( const BigInteger & rhs ) const
 {
 	//If they're equal, bigger will be this->_bits, and smaller will be rhs._bits
-	vector<uint32_t>* bigger = bigger_array( this->_bits, rhs._bits );
-	vector<uint32_t>* smaller = smaller_array( this->_bits, rhs._bits );
+	limb_vector* bigger = bigger_array( this->_bits, rhs._bits );
+	limb_vector* smaller = smaller_array( this->_bits, rhs._bits );
+	size_t common = smaller->size();
 
 	BigInteger ret;
 	ret._bits.resize( bigger->size() );
 
-	//the bits that need to be added together
-	uint32_t carry = 0;
-	for( size_t i = 0; i < smaller->size(); ++i )
-	{
-		int64_t res = (int64_t)( *smaller )[i] + ( *bigger )[i] + carry;
-		if( res > UINT32_MAX )
-		{
-			carry = 1;
-			res -= (int64_t)UINT32_MAX + 1;
-		}
-		else carry = 0;
-
-		ret._bits[i] = (uint32_t)res;
-	}
-
-	//now we have to handle the carry and the extra
-	for( size_t i = smaller->size(); i < bigger->size(); ++i )
-	{
-		int64_t res = (int64_t)( *bigger )[i] + carry;
-		if( res > UINT32_MAX )
-		{
-			carry = 1;
-			res -= (int64_t)UINT32_MAX + 1;
-		}
-		else carry = 0;
-
-		ret._bits[i] = (uint32_t)res;
-	}
+	//the bits that need to be added together, then the carry rippling through the extra
+	const limb_kernels::kernel_table& kernels = limb_kernels::active();
+	uint32_t carry = kernels.add_n( ret._bits.data(), bigger->data(), smaller->data(), common );
+	carry = kernels.add_1( ret._bits.data() + common, bigger->data() + common, bigger->size() - common, carry );
 
 	if( carry )
 		ret._bits.push_back( carry );
@@ -612,43 +593,82 @@ BigInteger BigInteger::internal_add( const BigInteger & rhs ) const
 BigInteger BigInteger::internal_sub( const BigInteger & rhs ) const
 {
 	//If they're equal, bigger will be this->_bits, and smaller will be rhs._bits
-	vector<uint32_t>* bigger = bigger_array( this->_bits, rhs._bits );
-	vector<uint32_t>* smaller = smaller_array( this->_bits, rhs._bits );
+	limb_vector* bigger = bigger_array( this->_bits, rhs._bits );
+	limb_vector* smaller = smaller_array( this->_bits, rhs._bits );
+	size_t common = smaller->size();
 
 	BigInteger ret;
 	ret._bits.resize( bigger->size() );
 
-	uint32_t borrow = 0;
-	for( size_t i = 0; i < smaller->size(); ++i )
-	{
-		int64_t res = (int64_t)( *bigger )[i] - ( *smaller )[i] - borrow;
-		if( res < 0 )
-		{
-			borrow = 1;
-			res += (int64_t)UINT32_MAX + 1;
-		}
-		else borrow = 0;
+	const limb_kernels::kernel_table& kernels = limb_kernels::active();
+	uint32_t borrow = kernels.sub_n( ret._bits.data(), bigger->data(), smaller->data(), common );
+	borrow = kernels.sub_1( ret._bits.data() + common, bigger->data() + common, bigger->size() - common, borrow );
 
-		ret._bits[i] = (uint32_t)res;
-	}
+	assert( borrow == 0 ); //this is only possible if 'this' < rhs
+	ret.trim();
 
-	for( size_t i = smaller->size(); i < bigger->size(); ++i )
-	{
-		int64_t res = (int64_t)( *bigger )[i] - borrow;
-		if( res < 0 )
-		{
-			borrow = 1;
-			res += (int64_t)UINT32_MAX + 1;
-		}
-		else borrow = 0;
+	return ret;
+}
+
+//One spare limb on top so the sign bit of the result never collides with a magnitude bit
+BigInteger BigInteger::bitwise( const BigInteger & lhs, const BigInteger & rhs, bitwise_op op )
+{
+	size_t size = max( lhs._bits.size(), rhs._bits.size() ) + 1;
+	limb_vector a( size ), b( size );
+	lhs.to_twos_complement( a );
+	rhs.to_twos_complement( b );
 
-		ret._bits[i] = (uint32_t)res;
+	const limb_kernels::kernel_table& kernels = limb_kernels::active();
+	switch( op )
+	{
+	case bitwise_and:
+		kernels.and_n( a.data(), a.data(), b.data(), size );
+		break;
+	case bitwise_or:
+		kernels.or_n( a.data(), a.data(), b.data(), size );
+		break;
+	case bitwise_xor:
+		kernels.xor_n( a.data(), a.data(), b.data(), size );
+		break;
 	}
 
-	assert( borrow == 0 ); //this is only possible if 'this' < rhs
-	ret.trim();
+	return from_twos_complement( a );
+}
 
-	return ret;
+void BigInteger::to_twos_complement( limb_vector& out ) const
+{
+	assert( out.size() > _bits.size() );
+	std::copy( _bits.begin(), _bits.end(), out.begin() );
+	std::fill( out.begin() + _bits.size(), out.end(), 0 );
+	if( _negative )
+		negate_limbs( out );
+}
+
+BigInteger BigInteger::from_twos_complement( limb_vector& limbs )
+{
+	BigInteger res;
+	res._negative = ( limbs.back() >> ( bits_per_value - 1 ) ) != 0;
+	if( res._negative )
+		negate_limbs( limbs );
+
+	res._bits.swap( limbs );
+	res.trim();
+	return res;
+}
+
+//-x == ~x + 1. The +1 only ripples through the low zero limbs, so everything above the lowest non-zero limb is a plain complement
+void BigInteger::negate_limbs( limb_vector& limbs )
+{
+	size_t size = limbs.size();
+	size_t lowest = 0;
+	while( lowest < size && limbs[lowest] == 0 )
+		++lowest;
+
+	if( lowest == size ) //-0 == 0
+		return;
+
+	limbs[lowest] = 0 - limbs[lowest];
+	limb_kernels::active().com_n( limbs.data() + lowest + 1, limbs.data() + lowest + 1, size - lowest - 1 );
 }
 
 BigInteger BigInteger::divide( const BigInteger & rhs, BigInteger* outer_remainder ) const
@@ -692,19 +712,19 @@ void BigInteger::trim()
 }
 
 //If they're equal, this function returns &_1
-vector<uint32_t>* BigInteger::bigger_array( const vector<uint32_t>& _1, const vector<uint32_t>& _2 )
+BigInteger::limb_vector* BigInteger::bigger_array( const limb_vector& _1, const limb_vector& _2 )
 {
 	if( _1.size() >= _2.size() )
-		return &const_cast<vector<uint32_t>&>( _1 );
-	else return &const_cast<vector<uint32_t>&>( _2 );
+		return &const_cast<limb_vector&>( _1 );
+	else return &const_cast<limb_vector&>( _2 );
 }
 
 //If they're equal, this function returns &_2
-vector<uint32_t>* BigInteger::smaller_array( const vector<uint32_t>& _1, const vector<uint32_t>& _2 )
+BigInteger::limb_vector* BigInteger::smaller_array( const limb_vector& _1, const limb_vector& _2 )
 {
 	if( _1.size() < _2.size() )
-		return &const_cast<vector<uint32_t>&>( _1 );
-	else return &const_cast<vector<uint32_t>&>( _2 );
+		return &const_cast<limb_vector&>( _1 );
+	else return &const_cast<limb_vector&>( _2 );
 }
 
 ostream& operator<<( ostream& os, const BigInteger& rhs )
@@ -7,10 +7,14 @@ using std::ostream;
 using std::istream;
 #include <string>
 using std::string;
+#include "AlignedAllocator.h"
 
 class BigInteger
 {
 public:
+	//Limb storage. Aligned to a cache line so the SIMD kernels in LimbKernels.h start on a full vector
+	typedef vector<uint32_t, AlignedAllocator<uint32_t, 64>> limb_vector;
+
 	const static BigInteger ZERO;
 	const static BigInteger ONE;
 	const static BigInteger TWO;
@@ -121,6 +125,27 @@ public:
 	//Binary >>= operator overload. Works the same as uint32_t's operator>>=
 	BigInteger& operator>>=( uint32_t rshift );
 
+	//The bitwise operators treat negative numbers as infinitely sign extended two's complement values, 
+	//so -1 is all ones and ( x & -x ) isolates the lowest set bit, just like int32_t
+
+	//Binary & operator overload. Works the same as int32_t's operator&
+	BigInteger operator&( const BigInteger& rhs ) const;
+	//Binary &= operator overload. Works the same as int32_t's operator&=
+	BigInteger& operator&=( const BigInteger& rhs );
+
+	//Binary | operator overload. Works the same as int32_t's operator|
+	BigInteger operator|( const BigInteger& rhs ) const;
+	//Binary |= operator overload. Works the same as int32_t's operator|=
+	BigInteger& operator|=( const BigInteger& rhs );
+
+	//Binary ^ operator overload. Works the same as int32_t's operator^
+	BigInteger operator^( const BigInteger& rhs ) const;
+	//Binary ^= operator overload. Works the same as int32_t's operator^=
+	BigInteger& operator^=( const BigInteger& rhs );
+
+	//Unary ~ operator overload. Works the same as int32_t's ~operator, so ~x == -x - 1
+	BigInteger operator~() const;
+
 	//Returns a hexadecimal string representation of the object
 	string to_string( uint32_t base = 10 ) const;
 	//Ostream overload, shortcut for outputting 'to_string()'
@@ -147,9 +172,18 @@ private:
 	BigInteger internal_sub( const BigInteger& rhs ) const;
 	void trim();
 
-	static inline vector<uint32_t>* bigger_array( const vector<uint32_t>& _1, const vector<uint32_t>& _2 );
-	static inline vector<uint32_t>* smaller_array( const vector<uint32_t>& _1, const vector<uint32_t>& _2 );
+	enum bitwise_op { bitwise_and, bitwise_or, bitwise_xor };
+	static BigInteger bitwise( const BigInteger& lhs, const BigInteger& rhs, bitwise_op op );
+	//Writes the sign extended two's complement form of the number into 'out', which must hold more limbs than _bits
+	void to_twos_complement( limb_vector& out ) const;
+	//Builds a sign-magnitude number out of a two's complement limb array. The top bit of the last limb is the sign
+	static BigInteger from_twos_complement( limb_vector& limbs );
+	//In place two's complement negation of a limb array
+	static void negate_limbs( limb_vector& limbs );
+
+	static inline limb_vector* bigger_array( const limb_vector& _1, const limb_vector& _2 );
+	static inline limb_vector* smaller_array( const limb_vector& _1, const limb_vector& _2 );
 	
 	bool _negative = false;
-	vector<uint32_t> _bits;
+	limb_vector _bits;
 };
\ No newline at end of file
@@ -0,0 +1,535 @@
+#include "LimbKernels.h"
+#include <cstring>
+using std::memcpy;
+
+#if defined( _M_X64 ) || defined( __x86_64__ )
+#define LIMB_KERNELS_X64 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+//GCC and clang only let us use an instruction set extension inside functions that ask for it.
+//MSVC lets any function use any intrinsic, so there the macro is empty
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define LIMB_KERNELS_TARGET( isa ) __attribute__( ( target( isa ) ) )
+#else
+#define LIMB_KERNELS_TARGET( isa )
+#endif
+
+namespace limb_kernels
+{
+
+//Portable implementations. A 64 bit accumulator holds every intermediate result, so no branches on carries
+
+static uint32_t add_n_scalar( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	uint64_t carry = 0;
+	for( size_t i = 0; i < n; ++i )
+	{
+		carry += (uint64_t)a[i] + b[i];
+		r[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	return (uint32_t)carry;
+}
+
+static uint32_t sub_n_scalar( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	uint32_t borrow = 0;
+	for( size_t i = 0; i < n; ++i )
+	{
+		uint64_t res = (uint64_t)a[i] - b[i] - borrow;
+		r[i] = (uint32_t)res;
+		borrow = (uint32_t)( res >> 32 ) & 1; //the high half is all ones if we wrapped around
+	}
+	return borrow;
+}
+
+static uint32_t add_1_scalar( uint32_t* r, const uint32_t* a, size_t n, uint32_t b )
+{
+	uint64_t carry = b;
+	size_t i = 0;
+	for( ; i < n && carry; ++i )
+	{
+		carry += a[i];
+		r[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	if( r != a ) //once the carry dies the rest is a plain copy
+		for( ; i < n; ++i )
+			r[i] = a[i];
+	return (uint32_t)carry;
+}
+
+static uint32_t sub_1_scalar( uint32_t* r, const uint32_t* a, size_t n, uint32_t b )
+{
+	uint32_t borrow = b;
+	size_t i = 0;
+	for( ; i < n && borrow; ++i )
+	{
+		uint64_t res = (uint64_t)a[i] - borrow;
+		r[i] = (uint32_t)res;
+		borrow = (uint32_t)( res >> 32 ) & 1;
+	}
+	if( r != a )
+		for( ; i < n; ++i )
+			r[i] = a[i];
+	return borrow;
+}
+
+static uint32_t mul_1_scalar( uint32_t* r, const uint32_t* a, size_t n, uint32_t b )
+{
+	uint64_t carry = 0;
+	for( size_t i = 0; i < n; ++i )
+	{
+		carry += (uint64_t)a[i] * b;
+		r[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	return (uint32_t)carry;
+}
+
+//(2^32 - 1)^2 + 2 * (2^32 - 1) == 2^64 - 1, so the product plus both addends always fits in 64 bits
+static uint32_t addmul_1_scalar( uint32_t* r, const uint32_t* a, size_t n, uint32_t b )
+{
+	uint64_t carry = 0;
+	for( size_t i = 0; i < n; ++i )
+	{
+		carry += (uint64_t)a[i] * b + r[i];
+		r[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	return (uint32_t)carry;
+}
+
+static int cmp_scalar( const uint32_t* a, const uint32_t* b, size_t n )
+{
+	while( n-- > 0 )
+	{
+		if( a[n] != b[n] )
+			return a[n] < b[n] ? -1 : 1;
+	}
+	return 0;
+}
+
+static void and_n_scalar( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	for( size_t i = 0; i < n; ++i )
+		r[i] = a[i] & b[i];
+}
+
+static void or_n_scalar( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	for( size_t i = 0; i < n; ++i )
+		r[i] = a[i] | b[i];
+}
+
+static void xor_n_scalar( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	for( size_t i = 0; i < n; ++i )
+		r[i] = a[i] ^ b[i];
+}
+
+static void com_n_scalar( uint32_t* r, const uint32_t* a, size_t n )
+{
+	for( size_t i = 0; i < n; ++i )
+		r[i] = ~a[i];
+}
+
+//Walks from the top down so r >= a overlap is safe
+static uint32_t lshift_scalar( uint32_t* r, const uint32_t* a, size_t n, unsigned shift )
+{
+	if( n == 0 )
+		return 0;
+
+	unsigned back = 32 - shift;
+	uint32_t out = a[n - 1] >> back;
+	for( size_t i = n - 1; i > 0; --i )
+		r[i] = ( a[i] << shift ) | ( a[i - 1] >> back );
+	r[0] = a[0] << shift;
+	return out;
+}
+
+//Walks from the bottom up so r <= a overlap is safe
+static uint32_t rshift_scalar( uint32_t* r, const uint32_t* a, size_t n, unsigned shift )
+{
+	if( n == 0 )
+		return 0;
+
+	unsigned back = 32 - shift;
+	uint32_t out = a[0] << back;
+	for( size_t i = 0; i + 1 < n; ++i )
+		r[i] = ( a[i] >> shift ) | ( a[i + 1] << back );
+	r[n - 1] = a[n - 1] >> shift;
+	return out;
+}
+
+#ifdef LIMB_KERNELS_X64
+
+//BMI2/ADX implementations. Pairs of limbs are treated as one 64 bit word, which halves the length of the
+//carry chain. Loads and stores go through memcpy since a pair isn't necessarily 8 byte aligned
+
+LIMB_KERNELS_TARGET( "adx" )
+static uint32_t add_n_adx( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	unsigned char carry = 0;
+	size_t i = 0;
+	for( ; i + 2 <= n; i += 2 )
+	{
+		unsigned long long x, y, z;
+		memcpy( &x, a + i, sizeof( x ) );
+		memcpy( &y, b + i, sizeof( y ) );
+		carry = _addcarryx_u64( carry, x, y, &z );
+		memcpy( r + i, &z, sizeof( z ) );
+	}
+	if( i < n )
+	{
+		uint64_t res = (uint64_t)a[i] + b[i] + carry;
+		r[i] = (uint32_t)res;
+		carry = (unsigned char)( res >> 32 );
+	}
+	return carry;
+}
+
+LIMB_KERNELS_TARGET( "adx" )
+static uint32_t sub_n_adx( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	unsigned char borrow = 0;
+	size_t i = 0;
+	for( ; i + 2 <= n; i += 2 )
+	{
+		unsigned long long x, y, z;
+		memcpy( &x, a + i, sizeof( x ) );
+		memcpy( &y, b + i, sizeof( y ) );
+		borrow = _subborrow_u64( borrow, x, y, &z );
+		memcpy( r + i, &z, sizeof( z ) );
+	}
+	if( i < n )
+	{
+		uint64_t res = (uint64_t)a[i] - b[i] - borrow;
+		r[i] = (uint32_t)res;
+		borrow = (unsigned char)( ( res >> 32 ) & 1 );
+	}
+	return borrow;
+}
+
+//A 64 bit word times a 32 bit limb is at most 96 bits, so the high half of mulx is the next carry limb
+LIMB_KERNELS_TARGET( "bmi2,adx" )
+static uint32_t mul_1_bmi2( uint32_t* r, const uint32_t* a, size_t n, uint32_t b )
+{
+	unsigned long long carry = 0;
+	size_t i = 0;
+	for( ; i + 2 <= n; i += 2 )
+	{
+		unsigned long long x, lo, hi;
+		memcpy( &x, a + i, sizeof( x ) );
+		lo = _mulx_u64( x, b, &hi );
+		hi += _addcarryx_u64( 0, lo, carry, &lo );
+		memcpy( r + i, &lo, sizeof( lo ) );
+		carry = hi;
+	}
+	if( i < n )
+	{
+		uint64_t res = (uint64_t)a[i] * b + carry;
+		r[i] = (uint32_t)res;
+		carry = res >> 32;
+	}
+	return (uint32_t)carry;
+}
+
+LIMB_KERNELS_TARGET( "bmi2,adx" )
+static uint32_t addmul_1_bmi2( uint32_t* r, const uint32_t* a, size_t n, uint32_t b )
+{
+	unsigned long long carry = 0;
+	size_t i = 0;
+	for( ; i + 2 <= n; i += 2 )
+	{
+		unsigned long long x, y, lo, hi;
+		memcpy( &x, a + i, sizeof( x ) );
+		memcpy( &y, r + i, sizeof( y ) );
+		lo = _mulx_u64( x, b, &hi );
+		//same bound as addmul_1_scalar one word wider, the product plus both addends never overflows hi
+		hi += _addcarryx_u64( 0, lo, carry, &lo );
+		hi += _addcarryx_u64( 0, lo, y, &lo );
+		memcpy( r + i, &lo, sizeof( lo ) );
+		carry = hi;
+	}
+	if( i < n )
+	{
+		uint64_t res = (uint64_t)a[i] * b + r[i] + carry;
+		r[i] = (uint32_t)res;
+		carry = res >> 32;
+	}
+	return (uint32_t)carry;
+}
+
+//AVX2 implementations of the data parallel sweeps. Eight limbs per instruction, scalar tail
+
+LIMB_KERNELS_TARGET( "avx2" )
+static void and_n_avx2( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	size_t i = 0;
+	for( ; i + 8 <= n; i += 8 )
+	{
+		__m256i x = _mm256_loadu_si256( (const __m256i*)( a + i ) );
+		__m256i y = _mm256_loadu_si256( (const __m256i*)( b + i ) );
+		_mm256_storeu_si256( (__m256i*)( r + i ), _mm256_and_si256( x, y ) );
+	}
+	and_n_scalar( r + i, a + i, b + i, n - i );
+}
+
+LIMB_KERNELS_TARGET( "avx2" )
+static void or_n_avx2( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	size_t i = 0;
+	for( ; i + 8 <= n; i += 8 )
+	{
+		__m256i x = _mm256_loadu_si256( (const __m256i*)( a + i ) );
+		__m256i y = _mm256_loadu_si256( (const __m256i*)( b + i ) );
+		_mm256_storeu_si256( (__m256i*)( r + i ), _mm256_or_si256( x, y ) );
+	}
+	or_n_scalar( r + i, a + i, b + i, n - i );
+}
+
+LIMB_KERNELS_TARGET( "avx2" )
+static void xor_n_avx2( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n )
+{
+	size_t i = 0;
+	for( ; i + 8 <= n; i += 8 )
+	{
+		__m256i x = _mm256_loadu_si256( (const __m256i*)( a + i ) );
+		__m256i y = _mm256_loadu_si256( (const __m256i*)( b + i ) );
+		_mm256_storeu_si256( (__m256i*)( r + i ), _mm256_xor_si256( x, y ) );
+	}
+	xor_n_scalar( r + i, a + i, b + i, n - i );
+}
+
+LIMB_KERNELS_TARGET( "avx2" )
+static void com_n_avx2( uint32_t* r, const uint32_t* a, size_t n )
+{
+	const __m256i ones = _mm256_set1_epi32( -1 );
+	size_t i = 0;
+	for( ; i + 8 <= n; i += 8 )
+	{
+		__m256i x = _mm256_loadu_si256( (const __m256i*)( a + i ) );
+		_mm256_storeu_si256( (__m256i*)( r + i ), _mm256_xor_si256( x, ones ) );
+	}
+	com_n_scalar( r + i, a + i, n - i );
+}
+
+//Skips over equal blocks of eight limbs from the top, then settles the first differing block limb by limb
+LIMB_KERNELS_TARGET( "avx2" )
+static int cmp_avx2( const uint32_t* a, const uint32_t* b, size_t n )
+{
+	while( n >= 8 )
+	{
+		__m256i x = _mm256_loadu_si256( (const __m256i*)( a + n - 8 ) );
+		__m256i y = _mm256_loadu_si256( (const __m256i*)( b + n - 8 ) );
+		if( _mm256_movemask_epi8( _mm256_cmpeq_epi32( x, y ) ) != -1 )
+			return cmp_scalar( a + n - 8, b + n - 8, 8 );
+		n -= 8;
+	}
+	return cmp_scalar( a, b, n );
+}
+
+//Each output limb only depends on two input limbs, so whole blocks shift independently.
+//Blocks go from the top down, same as the scalar version, so r >= a overlap stays safe
+LIMB_KERNELS_TARGET( "avx2" )
+static uint32_t lshift_avx2( uint32_t* r, const uint32_t* a, size_t n, unsigned shift )
+{
+	if( n == 0 )
+		return 0;
+
+	unsigned back = 32 - shift;
+	uint32_t out = a[n - 1] >> back;
+	const __m128i left = _mm_cvtsi32_si128( (int)shift );
+	const __m128i right = _mm_cvtsi32_si128( (int)back );
+
+	size_t i = n;
+	while( i >= 9 )
+	{
+		i -= 8;
+		__m256i hi = _mm256_loadu_si256( (const __m256i*)( a + i ) );
+		__m256i lo = _mm256_loadu_si256( (const __m256i*)( a + i - 1 ) );
+		__m256i res = _mm256_or_si256( _mm256_sll_epi32( hi, left ), _mm256_srl_epi32( lo, right ) );
+		_mm256_storeu_si256( (__m256i*)( r + i ), res );
+	}
+
+	//the bottom i limbs still need shifting. Their top limb pulls nothing from above, so the scalar version fits exactly
+	lshift_scalar( r, a, i, shift );
+	return out;
+}
+
+LIMB_KERNELS_TARGET( "avx2" )
+static uint32_t rshift_avx2( uint32_t* r, const uint32_t* a, size_t n, unsigned shift )
+{
+	if( n == 0 )
+		return 0;
+
+	unsigned back = 32 - shift;
+	uint32_t out = a[0] << back;
+	const __m128i right = _mm_cvtsi32_si128( (int)shift );
+	const __m128i left = _mm_cvtsi32_si128( (int)back );
+
+	size_t i = 0;
+	for( ; i + 9 <= n; i += 8 )
+	{
+		__m256i lo = _mm256_loadu_si256( (const __m256i*)( a + i ) );
+		__m256i hi = _mm256_loadu_si256( (const __m256i*)( a + i + 1 ) );
+		__m256i res = _mm256_or_si256( _mm256_srl_epi32( lo, right ), _mm256_sll_epi32( hi, left ) );
+		_mm256_storeu_si256( (__m256i*)( r + i ), res );
+	}
+
+	for( ; i + 1 < n; ++i )
+		r[i] = ( a[i] >> shift ) | ( a[i + 1] << back );
+	r[n - 1] = a[n - 1] >> shift;
+	return out;
+}
+
+struct cpu_features
+{
+	bool avx2 = false;
+	bool bmi2 = false;
+	bool adx = false;
+};
+
+static cpu_features detect_cpu()
+{
+	cpu_features features;
+	unsigned regs1[4] = { 0, 0, 0, 0 }, regs7[4] = { 0, 0, 0, 0 };
+	unsigned long long xcr0 = 0;
+
+#ifdef _MSC_VER
+	int r[4];
+	__cpuid( r, 0 );
+	unsigned max_leaf = (unsigned)r[0];
+	__cpuid( r, 1 );
+	for( int i = 0; i < 4; ++i )
+		regs1[i] = (unsigned)r[i];
+	if( max_leaf >= 7 )
+	{
+		__cpuidex( r, 7, 0 );
+		for( int i = 0; i < 4; ++i )
+			regs7[i] = (unsigned)r[i];
+	}
+	bool osxsave = ( regs1[2] >> 27 ) & 1;
+	if( osxsave )
+		xcr0 = _xgetbv( 0 );
+#else
+	unsigned max_leaf = __get_cpuid_max( 0, nullptr );
+	__get_cpuid( 1, &regs1[0], &regs1[1], &regs1[2], &regs1[3] );
+	if( max_leaf >= 7 )
+		__get_cpuid_count( 7, 0, &regs7[0], &regs7[1], &regs7[2], &regs7[3] );
+	bool osxsave = ( regs1[2] >> 27 ) & 1;
+	if( osxsave )
+	{
+		unsigned lo, hi;
+		__asm__( "xgetbv" : "=a"( lo ), "=d"( hi ) : "c"( 0 ) );
+		xcr0 = ( (unsigned long long)hi << 32 ) | lo;
+	}
+#endif
+
+	//the OS has to save the ymm registers on a context switch before AVX2 is usable, that's bits 1 and 2 of XCR0
+	bool avx_os = osxsave && ( regs1[2] >> 28 ) & 1 && ( xcr0 & 6 ) == 6;
+	features.avx2 = avx_os && ( regs7[1] >> 5 ) & 1;
+	features.bmi2 = ( regs7[1] >> 8 ) & 1;
+	features.adx = ( regs7[1] >> 19 ) & 1;
+	return features;
+}
+
+#endif //LIMB_KERNELS_X64
+
+static const kernel_table scalar_table = {
+	"scalar",
+	add_n_scalar, sub_n_scalar, add_1_scalar, sub_1_scalar, mul_1_scalar, addmul_1_scalar, cmp_scalar,
+	and_n_scalar, or_n_scalar, xor_n_scalar, com_n_scalar,
+	lshift_scalar, rshift_scalar
+};
+
+#ifdef LIMB_KERNELS_X64
+static const kernel_table bmi2_table = {
+	"bmi2",
+	add_n_adx, sub_n_adx, add_1_scalar, sub_1_scalar, mul_1_bmi2, addmul_1_bmi2, cmp_scalar,
+	and_n_scalar, or_n_scalar, xor_n_scalar, com_n_scalar,
+	lshift_scalar, rshift_scalar
+};
+
+static const kernel_table avx2_table = {
+	"avx2",
+	add_n_scalar, sub_n_scalar, add_1_scalar, sub_1_scalar, mul_1_scalar, addmul_1_scalar, cmp_avx2,
+	and_n_avx2, or_n_avx2, xor_n_avx2, com_n_avx2,
+	lshift_avx2, rshift_avx2
+};
+
+static const kernel_table avx2_bmi2_table = {
+	"avx2+bmi2",
+	add_n_adx, sub_n_adx, add_1_scalar, sub_1_scalar, mul_1_bmi2, addmul_1_bmi2, cmp_avx2,
+	and_n_avx2, or_n_avx2, xor_n_avx2, com_n_avx2,
+	lshift_avx2, rshift_avx2
+};
+#endif
+
+//Returns whether this CPU can run the passed table
+static bool supported( const kernel_table* table )
+{
+#ifdef LIMB_KERNELS_X64
+	static const cpu_features cpu = detect_cpu();
+	bool carry_ops = cpu.bmi2 && cpu.adx;
+	if( table == &bmi2_table )
+		return carry_ops;
+	if( table == &avx2_table )
+		return cpu.avx2;
+	if( table == &avx2_bmi2_table )
+		return cpu.avx2 && carry_ops;
+#endif
+	return table == &scalar_table;
+}
+
+//Best first
+static const kernel_table* const all_tables[] = {
+#ifdef LIMB_KERNELS_X64
+	&avx2_bmi2_table, &avx2_table, &bmi2_table,
+#endif
+	&scalar_table
+};
+
+static const kernel_table*& current()
+{
+	static const kernel_table* table = []
+	{
+		for( const kernel_table* t : all_tables )
+			if( supported( t ) )
+				return t;
+		return &scalar_table;
+	}();
+	return table;
+}
+
+const kernel_table& active()
+{
+	return *current();
+}
+
+const kernel_table& scalar()
+{
+	return scalar_table;
+}
+
+bool select( const char* name )
+{
+	for( const kernel_table* t : all_tables )
+	{
+		if( std::strcmp( t->name, name ) == 0 && supported( t ) )
+		{
+			current() = t;
+			return true;
+		}
+	}
+	return false;
+}
+
+}
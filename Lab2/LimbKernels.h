@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+//Linear sweeps over little-endian arrays of 32 bit limbs. Every BigInteger operation that walks its
+//limbs front to back bottoms out in one of these. Several implementations exist, the best one the
+//CPU supports is picked the first time active() is called and used from then on.
+//
+//Unless noted otherwise 'r' may alias 'a' or 'b' exactly, but must not partially overlap them.
+namespace limb_kernels
+{
+	struct kernel_table
+	{
+		//Human readable name of the implementation, e.g. "scalar" or "avx2+bmi2"
+		const char* name;
+
+		//r = a + b over n limbs. Returns the carry out (0 or 1)
+		uint32_t ( *add_n )( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n );
+		//r = a - b over n limbs. Returns the borrow out (0 or 1)
+		uint32_t ( *sub_n )( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n );
+		//r = a + b where b is a single limb. Returns the carry out
+		uint32_t ( *add_1 )( uint32_t* r, const uint32_t* a, size_t n, uint32_t b );
+		//r = a - b where b is a single limb. Returns the borrow out
+		uint32_t ( *sub_1 )( uint32_t* r, const uint32_t* a, size_t n, uint32_t b );
+		//r = a * b where b is a single limb. Returns the high limb of the product
+		uint32_t ( *mul_1 )( uint32_t* r, const uint32_t* a, size_t n, uint32_t b );
+		//r += a * b where b is a single limb. Returns the limb carried out of r[n - 1]
+		uint32_t ( *addmul_1 )( uint32_t* r, const uint32_t* a, size_t n, uint32_t b );
+		//Compares two n limb magnitudes. Returns -1, 0 or 1
+		int ( *cmp )( const uint32_t* a, const uint32_t* b, size_t n );
+
+		//r = a & b, r = a | b, r = a ^ b and r = ~a, limb by limb
+		void ( *and_n )( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n );
+		void ( *or_n )( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n );
+		void ( *xor_n )( uint32_t* r, const uint32_t* a, const uint32_t* b, size_t n );
+		void ( *com_n )( uint32_t* r, const uint32_t* a, size_t n );
+
+		//r = a << shift over n limbs, 0 < shift < 32. Returns the bits shifted out of the top limb
+		//r may overlap a as long as r >= a
+		uint32_t ( *lshift )( uint32_t* r, const uint32_t* a, size_t n, unsigned shift );
+		//r = a >> shift over n limbs, 0 < shift < 32. Returns the bits shifted out of the bottom limb, in the top of the result
+		//r may overlap a as long as r <= a
+		uint32_t ( *rshift )( uint32_t* r, const uint32_t* a, size_t n, unsigned shift );
+	};
+
+	//The implementation chosen for this CPU
+	const kernel_table& active();
+	//The portable implementation, always available. Handy as a reference to check the others against
+	const kernel_table& scalar();
+	//Forces a specific implementation by name. Returns false and leaves the selection alone if the name
+	//is unknown or the CPU can't run it. Not thread safe, call it before doing any arithmetic
+	bool select( const char* name );
+}